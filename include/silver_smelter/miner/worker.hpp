@@ -1,41 +1,72 @@
-#pragma once
-
-#include "silver_smelter/net/stratum.hpp" // This now correctly includes StratumV2Job
-#include <vector>
-#include <thread>
-#include <atomic>
-#include <memory>
-#include <mutex>
-
-class Miner {
-public:
-    // The constructor takes ownership of a StratumClient.
-    // The default argument for num_threads is only specified here in the header.
-    Miner(std::unique_ptr<StratumClient> client, int num_threads = 0);
-    ~Miner();
-
-    void start();
-    void stop();
-
-    // The callback method for the StratumClient to call.
-    // It now uses the StratumV2Job struct.
-    void on_new_job(StratumV2Job job);
-
-private:
-    void run_worker(int thread_id);
-
-    // --- Member Variables ---
-    std::unique_ptr<StratumClient> m_client;
-    
-    int m_num_threads;
-    std::vector<std::thread> m_threads;
-    
-    // This atomic flag tells workers to stop and get new work.
-    std::atomic<bool> m_new_job_available;
-    std::atomic<bool> m_is_running;
-
-    // The current job is shared between threads, so it needs a mutex.
-    // It is now a pointer to a StratumV2Job.
-    std::shared_ptr<StratumV2Job> m_current_job;
-    std::mutex m_job_mutex;
-};
\ No newline at end of file
+#pragma once
+
+#include "silver_smelter/net/stratum.hpp" // This now correctly includes StratumV2Job
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+class Miner {
+public:
+    // The constructor takes ownership of a StratumClient.
+    // The default argument for num_threads is only specified here in the header.
+    Miner(std::unique_ptr<StratumClient> client, int num_threads = 0);
+    ~Miner();
+
+    // Launches the workers. Pass connect_client = false to drive the miner
+    // from replayed frames instead of a live pool connection.
+    void start(bool connect_client = true);
+    void stop();
+
+    // Grows or shrinks the worker pool while mining continues.
+    // Surplus workers are retired, new ones are spawned, and the surviving
+    // workers pick up their rebalanced nonce ranges without being restarted.
+    void resize(int num_threads);
+    int thread_count() const;
+
+    // Drops the current pool session and connects to a different pool.
+    // Workers keep hashing the last job until the new pool sends one.
+    void switch_pool(const std::string& host, const std::string& port, const std::string& user, const std::string& pool_pub_key);
+
+    // Total number of hashes computed by all workers since start().
+    uint64_t hash_count() const;
+    // Number of jobs delivered to the miner since construction.
+    uint64_t job_count() const;
+
+    // The callback method for the StratumClient to call.
+    // It now uses the StratumV2Job struct.
+    void on_new_job(StratumV2Job job);
+
+private:
+    // Each worker owns a retire flag so it can be stopped on its own
+    // when the pool shrinks, without touching the other workers.
+    struct WorkerSlot {
+        std::thread thread;
+        std::atomic<bool> retire{false};
+    };
+
+    void spawn_worker(int thread_id);
+    void run_worker(int thread_id, const std::atomic<bool>& retire);
+
+    // --- Member Variables ---
+    std::unique_ptr<StratumClient> m_client;
+
+    std::atomic<int> m_num_threads;
+    std::vector<std::unique_ptr<WorkerSlot>> m_workers;
+    std::mutex m_pool_mutex; // Serialises start/stop/resize.
+
+    // This atomic flag tells workers to stop and get new work.
+    std::atomic<bool> m_new_job_available;
+    std::atomic<bool> m_is_running;
+
+    // Bumped whenever the pool is resized so workers recompute their nonce range.
+    std::atomic<uint32_t> m_partition_generation;
+    std::atomic<uint64_t> m_hash_count;
+    std::atomic<uint64_t> m_job_count;
+
+    // The current job is shared between threads, so it needs a mutex.
+    // It is now a pointer to a StratumV2Job.
+    std::shared_ptr<StratumV2Job> m_current_job;
+    std::mutex m_job_mutex;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "v2_protocol.hpp"
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Binary capture of the raw Stratum V2 frames received from a pool.
+//
+// File layout (native byte order):
+//   "SSCAP001"                                  - 8-byte magic
+//   repeated records:
+//     uint64_t      receive time, microseconds since the capture started
+//     MessageHeader the frame header as received (4 bytes)
+//     char[msg_len] the frame body
+
+// One frame read back from a capture file.
+struct CaptureFrame {
+    uint64_t timestamp_us;
+    MessageHeader header;
+    std::vector<char> body;
+};
+
+class CaptureWriter {
+public:
+    explicit CaptureWriter(const std::string& path);
+
+    bool is_open() const;
+    // Appends a frame, stamped with the time elapsed since the writer was opened.
+    void write_frame(const MessageHeader& header, const std::vector<char>& body);
+
+private:
+    std::ofstream m_file;
+    std::chrono::steady_clock::time_point m_start_time;
+};
+
+class CaptureReader {
+public:
+    explicit CaptureReader(const std::string& path);
+
+    // False if the file is missing or does not start with the capture magic.
+    bool is_open() const;
+    // Reads the next frame. Returns false at end of file or on a truncated record.
+    bool next(CaptureFrame& frame);
+
+private:
+    std::ifstream m_file;
+    bool m_valid;
+};
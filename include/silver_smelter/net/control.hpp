@@ -0,0 +1,42 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <functional>
+#include <string>
+
+class Miner;
+
+// A local Unix-domain control socket for a running miner.
+// Clients send one newline-terminated text command per line and get a
+// single "OK ..." or "ERR ..." line back. Supported commands:
+//
+//   status                               - thread count and total hashes
+//   threads <n>                          - grow or shrink the worker pool
+//   pool <host> <port> <user> [pub_key]  - switch to a different pool
+//   bench [seconds]                      - measure the live hash rate
+//   shutdown                             - stop the daemon
+class ControlServer {
+public:
+    using ShutdownCallback = std::function<void()>;
+
+    ControlServer(boost::asio::io_context& ioc, const std::string& socket_path, Miner& miner, ShutdownCallback on_shutdown);
+    ~ControlServer();
+
+    void start();
+    void stop();
+
+private:
+    class Session;
+
+    void do_accept();
+    // Handles one command line; calls reply exactly once, possibly later.
+    void handle_command(const std::string& line, std::function<void(const std::string&)> reply);
+
+    // --- Member Variables ---
+    boost::asio::io_context& m_ioc;
+    boost::asio::local::stream_protocol::acceptor m_acceptor;
+    std::string m_socket_path;
+
+    Miner& m_miner;
+    ShutdownCallback m_on_shutdown;
+};
@@ -1,31 +1,115 @@
 #include "silver_smelter/miner/worker.hpp"
+#include "silver_smelter/net/control.hpp"
 #include "silver_smelter/util/log.hpp"
 #include <boost/asio.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <future>
 #include <thread>
 #include <iostream>
 
+static void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --host <host>         Pool host\n"
+              << "  --port <port>         Pool port\n"
+              << "  --user <user>         Worker identity\n"
+              << "  --pool-key <key>      Pool public key\n"
+              << "  --threads <n>         Worker threads (default: all cores)\n"
+              << "  --daemon              Run until SIGINT/SIGTERM instead of waiting for Enter\n"
+              << "  --control <path>      Unix socket for runtime control (implies --daemon)\n"
+              << "  --capture <path>      Record received pool frames for silver_smelter_replay\n";
+}
+
 int main(int argc, char* argv[]) {
     Log::info("Silver-Smelter Bitcoin Miner starting...");
 
     // --- Configuration from your Stratum V2 URI ---
-    const std::string host = "v2.us-east.stratum.braiins.com";  
-    const std::string port = "3334";                            
-    const std::string user = "Seraphic-Syntax.Silver-Smelter";   
-    const std::string pool_public_key_str = "u95GEReVMjK6k5YqiSFNqqTnKU4ypU2Wm8awa6tmbmDmk1bWt"; 
+    std::string host = "v2.us-east.stratum.braiins.com";
+    std::string port = "3334";
+    std::string user = "Seraphic-Syntax.Silver-Smelter";
+    std::string pool_public_key_str = "u95GEReVMjK6k5YqiSFNqqTnKU4ypU2Wm8awa6tmbmDmk1bWt";
     // ---------------------------------------------------
 
+    int num_threads = 0;
+    bool daemon_mode = false;
+    std::string control_path;
+    std::string capture_path;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--host" && has_value) {
+            host = argv[++i];
+        } else if (arg == "--port" && has_value) {
+            port = argv[++i];
+        } else if (arg == "--user" && has_value) {
+            user = argv[++i];
+        } else if (arg == "--pool-key" && has_value) {
+            pool_public_key_str = argv[++i];
+        } else if (arg == "--threads" && has_value) {
+            num_threads = std::atoi(argv[++i]);
+        } else if (arg == "--daemon") {
+            daemon_mode = true;
+        } else if (arg == "--control" && has_value) {
+            control_path = argv[++i];
+            daemon_mode = true;
+        } else if (arg == "--capture" && has_value) {
+            capture_path = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
     Log::info("Pool: " + host + ":" + port);
     Log::info("User: " + user);
 
     // --- Setup Asynchronous I/O ---
     boost::asio::io_context ioc;
+    // Keep ioc.run() alive even while there is no outstanding network work.
+    auto work_guard = boost::asio::make_work_guard(ioc);
 
     // --- Create Miner Components ---
     // Create a StratumClient, now passing all 5 arguments including the public key.
     auto client = std::make_unique<StratumClient>(ioc, host, port, user, pool_public_key_str);
+    if (!capture_path.empty()) {
+        client->enable_capture(capture_path);
+    }
 
     // Create the Miner, giving it ownership of the client.
-    Miner miner(std::move(client));
+    Miner miner(std::move(client), num_threads);
+
+    // Both signals and the control socket funnel into the same one-shot shutdown.
+    std::promise<void> shutdown_promise;
+    std::atomic<bool> shutdown_requested(false);
+    auto request_shutdown = [&]() {
+        if (!shutdown_requested.exchange(true)) {
+            shutdown_promise.set_value();
+        }
+    };
+
+    boost::asio::signal_set signals(ioc);
+    std::unique_ptr<ControlServer> control;
+    if (daemon_mode) {
+        signals.add(SIGINT);
+        signals.add(SIGTERM);
+        signals.async_wait([&](const boost::system::error_code& ec, int signal_number) {
+            if (!ec) {
+                Log::warn("Received signal " + std::to_string(signal_number) + ".");
+                request_shutdown();
+            }
+        });
+
+        if (!control_path.empty()) {
+            control = std::make_unique<ControlServer>(ioc, control_path, miner, request_shutdown);
+            try {
+                control->start();
+            } catch (const std::exception& e) {
+                Log::error("Failed to open control socket " + control_path + ": " + e.what());
+                return 1;
+            }
+        }
+    }
 
     // --- Start Threads ---
     std::thread network_thread([&ioc]() {
@@ -36,21 +120,32 @@ int main(int argc, char* argv[]) {
         }
     });
     Log::info("Network thread started.");
-    
+
     // Start the miner. This will connect and launch the worker threads.
     miner.start();
 
     // --- Wait for shutdown signal ---
-    Log::info("Miner is running. Press Enter to stop.");
-    std::cin.get(); // Wait for user to press Enter.
+    if (daemon_mode) {
+        Log::info("Miner is running in daemon mode. Send SIGINT or SIGTERM to stop.");
+        shutdown_promise.get_future().wait();
+        Log::warn("Shutdown initiated by signal or control command.");
+    } else {
+        Log::info("Miner is running. Press Enter to stop.");
+        std::cin.get(); // Wait for user to press Enter.
+        Log::warn("Shutdown initiated by user.");
+    }
 
     // --- Graceful Shutdown ---
-    Log::warn("Shutdown initiated by user.");
-    
+    // Stop accepting control commands before tearing down the miner.
+    if (control) {
+        boost::asio::post(ioc, [&control]() { control->stop(); });
+    }
+
     // Stop the miner (signals workers, closes socket).
     miner.stop();
 
     // Stop the io_context. This will unblock ioc.run() in the network thread.
+    work_guard.reset();
     ioc.stop();
 
     // Wait for the network thread to finish its cleanup.
@@ -60,4 +155,4 @@ int main(int argc, char* argv[]) {
 
     Log::success("Silver-Smelter has shut down cleanly.");
     return 0;
-}
\ No newline at end of file
+}
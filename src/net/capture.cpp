@@ -0,0 +1,65 @@
+#include "silver_smelter/net/capture.hpp"
+#include "silver_smelter/util/log.hpp"
+#include <cstring>
+
+static const char CAPTURE_MAGIC[8] = {'S', 'S', 'C', 'A', 'P', '0', '0', '1'};
+
+CaptureWriter::CaptureWriter(const std::string& path)
+    : m_file(path, std::ios::binary | std::ios::trunc),
+      m_start_time(std::chrono::steady_clock::now())
+{
+    if (!m_file) {
+        Log::error("Could not open capture file " + path);
+        return;
+    }
+    m_file.write(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    Log::info("Capturing pool traffic to " + path);
+}
+
+bool CaptureWriter::is_open() const {
+    return m_file.is_open() && m_file.good();
+}
+
+void CaptureWriter::write_frame(const MessageHeader& header, const std::vector<char>& body) {
+    if (!is_open()) {
+        return;
+    }
+    const uint64_t timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - m_start_time).count();
+
+    m_file.write(reinterpret_cast<const char*>(&timestamp_us), sizeof(timestamp_us));
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(MessageHeader));
+    m_file.write(body.data(), body.size());
+    // Flush per frame so a crash or kill still leaves a usable capture.
+    m_file.flush();
+}
+
+CaptureReader::CaptureReader(const std::string& path)
+    : m_file(path, std::ios::binary),
+      m_valid(false)
+{
+    char magic[sizeof(CAPTURE_MAGIC)];
+    if (m_file.read(magic, sizeof(magic)) && memcmp(magic, CAPTURE_MAGIC, sizeof(magic)) == 0) {
+        m_valid = true;
+    }
+}
+
+bool CaptureReader::is_open() const {
+    return m_valid;
+}
+
+bool CaptureReader::next(CaptureFrame& frame) {
+    if (!m_valid) {
+        return false;
+    }
+    if (!m_file.read(reinterpret_cast<char*>(&frame.timestamp_us), sizeof(frame.timestamp_us)) ||
+        !m_file.read(reinterpret_cast<char*>(&frame.header), sizeof(MessageHeader))) {
+        return false;
+    }
+    frame.body.resize(frame.header.msg_len);
+    if (frame.header.msg_len > 0 && !m_file.read(frame.body.data(), frame.body.size())) {
+        Log::warn("Capture file ends with a truncated frame.");
+        return false;
+    }
+    return true;
+}
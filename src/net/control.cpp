@@ -0,0 +1,172 @@
+#include "silver_smelter/net/control.hpp"
+#include "silver_smelter/miner/worker.hpp"
+#include "silver_smelter/util/log.hpp"
+#include <chrono>
+#include <cstdio>
+#include <istream>
+#include <memory>
+#include <sstream>
+
+namespace asio = boost::asio;
+using asio::local::stream_protocol;
+
+// One connected control client. Keeps itself alive through shared_from_this
+// for as long as a read or write is pending.
+class ControlServer::Session : public std::enable_shared_from_this<ControlServer::Session> {
+public:
+    Session(stream_protocol::socket socket, ControlServer& server)
+        : m_socket(std::move(socket)),
+          m_server(server)
+    {}
+
+    void start() {
+        do_read();
+    }
+
+private:
+    void do_read() {
+        auto self = shared_from_this();
+        asio::async_read_until(m_socket, m_buffer, '\n',
+            [this, self](const boost::system::error_code& ec, std::size_t /*bytes*/) {
+                if (ec) {
+                    return; // Client went away.
+                }
+                std::istream stream(&m_buffer);
+                std::string line;
+                std::getline(stream, line);
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                m_server.handle_command(line, [this, self](const std::string& response) {
+                    do_write(response);
+                });
+            });
+    }
+
+    void do_write(const std::string& response) {
+        auto self = shared_from_this();
+        auto message = std::make_shared<std::string>(response + "\n");
+        asio::async_write(m_socket, asio::buffer(*message),
+            [this, self, message](const boost::system::error_code& ec, std::size_t /*bytes*/) {
+                if (!ec) {
+                    do_read(); // Wait for the next command.
+                }
+            });
+    }
+
+    stream_protocol::socket m_socket;
+    asio::streambuf m_buffer;
+    ControlServer& m_server;
+};
+
+ControlServer::ControlServer(asio::io_context& ioc, const std::string& socket_path, Miner& miner, ShutdownCallback on_shutdown)
+    : m_ioc(ioc),
+      m_acceptor(ioc),
+      m_socket_path(socket_path),
+      m_miner(miner),
+      m_on_shutdown(std::move(on_shutdown))
+{}
+
+ControlServer::~ControlServer() {
+    stop();
+}
+
+void ControlServer::start() {
+    // A stale socket file from a previous run would make bind() fail.
+    std::remove(m_socket_path.c_str());
+
+    stream_protocol::endpoint endpoint(m_socket_path);
+    m_acceptor.open(endpoint.protocol());
+    m_acceptor.bind(endpoint);
+    m_acceptor.listen();
+
+    Log::info("Control socket listening on " + m_socket_path);
+    do_accept();
+}
+
+void ControlServer::stop() {
+    if (m_acceptor.is_open()) {
+        boost::system::error_code ec;
+        m_acceptor.close(ec);
+        std::remove(m_socket_path.c_str());
+    }
+}
+
+void ControlServer::do_accept() {
+    m_acceptor.async_accept(
+        [this](const boost::system::error_code& ec, stream_protocol::socket socket) {
+            if (ec) {
+                if (ec != asio::error::operation_aborted) {
+                    Log::error("Control socket accept failed: " + ec.message());
+                }
+                return;
+            }
+            std::make_shared<Session>(std::move(socket), *this)->start();
+            do_accept();
+        });
+}
+
+void ControlServer::handle_command(const std::string& line, std::function<void(const std::string&)> reply) {
+    std::istringstream args(line);
+    std::string command;
+    args >> command;
+
+    if (command.empty()) {
+        reply("ERR empty command");
+        return;
+    }
+    Log::info("Control command: " + line);
+
+    if (command == "status") {
+        reply("OK threads=" + std::to_string(m_miner.thread_count()) +
+              " hashes=" + std::to_string(m_miner.hash_count()));
+    } else if (command == "threads") {
+        int num_threads = 0;
+        if (!(args >> num_threads) || num_threads <= 0) {
+            reply("ERR usage: threads <n>");
+            return;
+        }
+        m_miner.resize(num_threads);
+        reply("OK threads=" + std::to_string(m_miner.thread_count()));
+    } else if (command == "pool") {
+        std::string host, port, user, pool_pub_key;
+        if (!(args >> host >> port >> user)) {
+            reply("ERR usage: pool <host> <port> <user> [pub_key]");
+            return;
+        }
+        args >> pool_pub_key; // Optional; unencrypted connections don't use it.
+        m_miner.switch_pool(host, port, user, pool_pub_key);
+        reply("OK switching to " + host + ":" + port);
+    } else if (command == "bench") {
+        int seconds = 10;
+        args >> seconds;
+        if (seconds <= 0) {
+            reply("ERR usage: bench [seconds]");
+            return;
+        }
+
+        // Sample the live hash counter over the window without blocking the io_context.
+        auto timer = std::make_shared<asio::steady_timer>(m_ioc, std::chrono::seconds(seconds));
+        const uint64_t start_hashes = m_miner.hash_count();
+        const auto start_time = std::chrono::steady_clock::now();
+        timer->async_wait([this, timer, start_hashes, start_time, reply](const boost::system::error_code& ec) {
+            if (ec) {
+                reply("ERR benchmark cancelled");
+                return;
+            }
+            const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+            const uint64_t hashes = m_miner.hash_count() - start_hashes;
+            const uint64_t hash_rate = static_cast<uint64_t>(hashes / elapsed);
+            Log::success("Benchmark: " + std::to_string(hash_rate) + " H/s on " + std::to_string(m_miner.thread_count()) + " threads.");
+            reply("OK hashrate=" + std::to_string(hash_rate) + " H/s hashes=" + std::to_string(hashes) +
+                  " threads=" + std::to_string(m_miner.thread_count()));
+        });
+    } else if (command == "shutdown") {
+        reply("OK shutting down");
+        if (m_on_shutdown) {
+            m_on_shutdown();
+        }
+    } else {
+        reply("ERR unknown command: " + command);
+    }
+}
@@ -0,0 +1,121 @@
+#include "silver_smelter/miner/worker.hpp"
+#include "silver_smelter/net/capture.hpp"
+#include "silver_smelter/util/log.hpp"
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+// Replays a capture recorded with `silver_smelter --capture` through the
+// StratumClient message handling and into a Miner, and reports how fast the
+// frames were parsed and turned into job switches.
+
+static void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " <capture-file> [options]\n"
+              << "  --realtime            Honour the recorded inter-frame timing (default: as fast as possible)\n"
+              << "  --threads <n>         Worker threads for the miner (default: 1)\n"
+              << "  --parse-only          Only parse frames and build jobs; don't start a miner\n"
+              << "  --loops <n>           Replay the capture n times (default: 1)\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const std::string capture_path = argv[1];
+    bool realtime = false;
+    bool parse_only = false;
+    int num_threads = 1;
+    int loops = 1;
+
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--realtime") {
+            realtime = true;
+        } else if (arg == "--parse-only") {
+            parse_only = true;
+        } else if (arg == "--threads" && has_value) {
+            num_threads = std::atoi(argv[++i]);
+        } else if (arg == "--loops" && has_value) {
+            loops = std::max(1, std::atoi(argv[++i]));
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!CaptureReader(capture_path).is_open()) {
+        Log::error("Not a Silver-Smelter capture file: " + capture_path);
+        return 1;
+    }
+
+    // The client is never connected; its io_context is only needed to construct it.
+    boost::asio::io_context ioc;
+    auto client = std::make_unique<StratumClient>(ioc, "replay", "0", "replay", "");
+    StratumClient* replay_client = client.get();
+
+    std::unique_ptr<Miner> miner;
+    uint64_t parsed_jobs = 0;
+    if (parse_only) {
+        replay_client->on_new_job([&parsed_jobs](StratumV2Job /*job*/) {
+            ++parsed_jobs;
+        });
+    } else {
+        miner = std::make_unique<Miner>(std::move(client), num_threads);
+        miner->start(false);
+    }
+
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    std::chrono::nanoseconds dispatch_total(0);
+    std::chrono::nanoseconds dispatch_max(0);
+
+    const auto replay_start = std::chrono::steady_clock::now();
+    for (int loop = 0; loop < loops; ++loop) {
+        CaptureReader reader(capture_path);
+        const auto loop_start = std::chrono::steady_clock::now();
+        CaptureFrame frame;
+        while (reader.next(frame)) {
+            if (realtime) {
+                std::this_thread::sleep_until(loop_start + std::chrono::microseconds(frame.timestamp_us));
+            }
+
+            const auto dispatch_start = std::chrono::steady_clock::now();
+            replay_client->replay_frame(frame.header, frame.body);
+            const auto dispatch_time = std::chrono::steady_clock::now() - dispatch_start;
+
+            dispatch_total += dispatch_time;
+            dispatch_max = std::max<std::chrono::nanoseconds>(dispatch_max, dispatch_time);
+            ++frames;
+            bytes += sizeof(MessageHeader) + frame.body.size();
+        }
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - replay_start).count();
+
+    uint64_t jobs = parsed_jobs;
+    uint64_t hashes = 0;
+    if (miner) {
+        miner->stop();
+        jobs = miner->job_count();
+        hashes = miner->hash_count();
+    }
+
+    const double dispatch_seconds = std::chrono::duration<double>(dispatch_total).count();
+    Log::success("Replay finished: " + std::to_string(frames) + " frames, " + std::to_string(bytes) + " bytes, " +
+                 std::to_string(jobs) + " jobs in " + std::to_string(elapsed) + " s.");
+    if (frames > 0 && dispatch_seconds > 0) {
+        Log::info("Dispatch: " + std::to_string(static_cast<uint64_t>(frames / dispatch_seconds)) + " frames/s, " +
+                  std::to_string(static_cast<uint64_t>(jobs / dispatch_seconds)) + " jobs/s, mean " +
+                  std::to_string(dispatch_total.count() / frames / 1000) + " us, max " +
+                  std::to_string(dispatch_max.count() / 1000) + " us per frame.");
+    }
+    if (miner) {
+        Log::info("Miner computed " + std::to_string(hashes) + " hashes on " + std::to_string(num_threads) + " threads.");
+    }
+    return 0;
+}